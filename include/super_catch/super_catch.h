@@ -27,6 +27,10 @@
 #define SUPER_CATCH_IS_POSIX
 #endif
 
+#if defined(__linux__)
+#define SUPER_CATCH_IS_LINUX
+#endif
+
 // Platforms
 #if defined(SUPER_CATCH_IS_WIN) && defined(_MSC_VER) && !defined(__clang__)
 #define SUPER_CATCH_PLAT_WIN_MSVC
@@ -151,10 +155,27 @@ namespace super_catch {
         do
 #define SUPER_CATCH while(0); } catch
 
+// Circuit breaker is POSIX only, keep call sites portable
+#define SUPER_TRY_BREAKER SUPER_TRY
+
 #elif defined(SUPER_CATCH_PLAT_POSIX_COMPATIBLE)
 
 // Posix version using signal handler
+#include <atomic>
 #include <csetjmp>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(SUPER_CATCH_IS_LINUX)
+#include <functional>
+#include <initializer_list>
+#include <map>
+#include <mutex>
+#include <thread>
+#endif
 
 namespace super_catch {
 #define SIG_ENUM(name, sig) sig_ ##name = sig,
@@ -225,10 +246,325 @@ namespace super_catch {
         sigjmp_buf_chain *sigjmp_chain_push();
 
         void sigjmp_chain_pop();
+
+        [[noreturn]] void throw_signal_exception(int sig);
     }
 }
 
-#define SUPER_CATCH_POSIX_PUSH_SIGNAL_HANDLER(ln) \
+namespace super_catch {
+    // Zero fields fall back to the global config (see set_circuit_breaker_config).
+    struct circuit_breaker_config {
+        // open when faults * 100 >= failure_percent * calls within the window
+        uint32_t failure_percent = 0;
+        // minimum calls within the window before the rate is evaluated
+        uint32_t min_calls = 0;
+        uint32_t window_ms = 0;
+        // time spent open before a single probe call is let through (half-open)
+        uint32_t cooldown_ms = 0;
+    };
+
+    void set_circuit_breaker_config(const circuit_breaker_config &config);
+
+    circuit_breaker_config get_circuit_breaker_config();
+
+    class circuit_breaker {
+    public:
+        enum state_enum: int {
+            closed,
+            open,
+            half_open,
+        };
+
+        enum admission_enum: int {
+            rejected,
+            admitted,
+            // the single call let through while half open, only its outcome leaves half open
+            probe,
+        };
+
+        circuit_breaker(const char *file, int line) noexcept;
+
+        circuit_breaker(const circuit_breaker &) = delete;
+
+        circuit_breaker &operator=(const circuit_breaker &) = delete;
+
+        admission_enum allow() noexcept;
+
+        // admission is what allow() returned for the finishing call
+        void record_success(admission_enum admission) noexcept;
+
+        void record_fault(admission_enum admission) noexcept;
+
+        // Overrides the global config for this site only.
+        void configure(const circuit_breaker_config &config) noexcept;
+
+        void reset() noexcept;
+
+        state_enum state() const noexcept { return static_cast<state_enum>(state_.load(std::memory_order_relaxed)); }
+
+        const char *file() const noexcept { return file_; }
+
+        int line() const noexcept { return line_; }
+
+        circuit_breaker *next() const noexcept { return next_; }
+
+    private:
+        static constexpr int stripe_count = 8;
+        static constexpr int bucket_count = 10;
+
+        struct bucket {
+            std::atomic<int64_t> epoch{-1};
+            std::atomic<uint32_t> calls{0};
+            std::atomic<uint32_t> faults{0};
+        };
+
+        // one row per thread stripe, so concurrent threads rarely touch the same cache line
+        struct alignas(64) stripe {
+            bucket buckets[bucket_count];
+        };
+
+        circuit_breaker_config effective_config() const noexcept;
+
+        void record(bool fault, int64_t now_ms, const circuit_breaker_config &config) noexcept;
+
+        bool should_trip(int64_t now_ms, const circuit_breaker_config &config) const noexcept;
+
+        void trip(int64_t now_ms) noexcept;
+
+        const char *const file_;
+        const int line_;
+        circuit_breaker *next_ = nullptr;
+
+        std::atomic<int> state_{closed};
+        std::atomic<int64_t> opened_at_ms_{0};
+
+        std::atomic<uint32_t> failure_percent_{0};
+        std::atomic<uint32_t> min_calls_{0};
+        std::atomic<uint32_t> window_ms_{0};
+        std::atomic<uint32_t> cooldown_ms_{0};
+
+        stripe stripes_[stripe_count];
+    };
+
+    // Every breaker ever reached, most recently constructed first. The list never shrinks, so
+    // breakers must have static storage duration (SUPER_TRY_BREAKER declares them static).
+    circuit_breaker *circuit_breakers() noexcept;
+
+    class circuit_open_exception final : public std::exception {
+        const circuit_breaker &breaker_;
+
+    public:
+        explicit circuit_open_exception(const circuit_breaker &breaker) noexcept: breaker_(breaker) {
+        }
+
+        const circuit_breaker &breaker() const noexcept { return breaker_; }
+
+        const char *what() const noexcept override {
+            return "circuit open";
+        }
+    };
+
+    namespace detail {
+        class circuit_breaker_scope {
+            circuit_breaker &breaker_;
+            const circuit_breaker::admission_enum admission_;
+            bool faulted_ = false;
+
+        public:
+            explicit circuit_breaker_scope(circuit_breaker &breaker): breaker_(breaker), admission_(breaker.allow()) {
+                if (admission_ == circuit_breaker::rejected) {
+                    throw circuit_open_exception(breaker_);
+                }
+            }
+
+            ~circuit_breaker_scope() {
+                if (faulted_) {
+                    breaker_.record_fault(admission_);
+                } else {
+                    breaker_.record_success(admission_);
+                }
+            }
+
+            void fault() noexcept { faulted_ = true; }
+        };
+    }
+}
+
+namespace super_catch {
+    // Thrown by SUPER_TRY for a caught signal. module_id() is the loaded module containing the
+    // faulting instruction (see modules()), or -1 if unknown or not supported on this platform.
+    // Aborts and faults inside libc are attributed to the first calling module outside of libc.
+    class signal_exception : public std::system_error {
+    public:
+        signal_exception(int sig, int module_id, const void *pc);
+
+        int module_id() const noexcept { return module_id_; }
+
+        const void *pc() const noexcept { return pc_; }
+
+    private:
+        int module_id_;
+        const void *pc_;
+    };
+
+    // Sampling guard-page allocator. A small fraction of sampling_malloc() calls are served from a
+    // pool of page-sized slots separated by inaccessible guard pages, freed slots are protected.
+    // Faults in the pool are classified and thrown as memory_error inside SUPER_TRY, or reported
+    // to stderr outside of one.
+    // Only callers using sampling_malloc()/sampling_free() are sampled, plain malloc and operator
+    // new are not redirected. Memory from the pool must never be passed to free().
+    struct guarded_allocator_options {
+        size_t slot_count = 256;
+        // one in sample_rate allocations on average goes to the pool, 0 disables sampling
+        uint32_t sample_rate = 5000;
+    };
+
+    void init_guarded_allocator(const guarded_allocator_options &options = guarded_allocator_options());
+
+    void *sampling_malloc(size_t size);
+
+    void sampling_free(void *ptr);
+
+    // Always allocates from the pool, returns nullptr if it is full or size exceeds a page.
+    void *guarded_malloc(size_t size);
+
+    void guarded_free(void *ptr);
+
+    bool guarded_owns(const void *ptr) noexcept;
+
+    enum class memory_error_type: int {
+        unknown,
+        buffer_overflow,
+        buffer_underflow,
+        use_after_free,
+        double_free,
+    };
+
+    const char *memory_error_description(memory_error_type type) noexcept;
+
+    class memory_error final : public signal_exception {
+    public:
+        memory_error(int sig, int module_id, const void *pc, memory_error_type type, const void *fault_address,
+                     const void *allocation, size_t allocation_size, std::vector<void *> allocation_trace,
+                     std::vector<void *> deallocation_trace);
+
+        memory_error_type type() const noexcept { return type_; }
+
+        const void *fault_address() const noexcept { return fault_address_; }
+
+        const void *allocation() const noexcept { return allocation_; }
+
+        size_t allocation_size() const noexcept { return allocation_size_; }
+
+        const std::vector<void *> &allocation_trace() const noexcept { return allocation_trace_; }
+
+        const std::vector<void *> &deallocation_trace() const noexcept { return deallocation_trace_; }
+
+        const char *what() const noexcept override {
+            return msg_.c_str();
+        }
+
+    private:
+        memory_error_type type_;
+        const void *fault_address_;
+        const void *allocation_;
+        size_t allocation_size_;
+        std::vector<void *> allocation_trace_;
+        std::vector<void *> deallocation_trace_;
+        std::string msg_;
+    };
+}
+
+#if defined(SUPER_CATCH_IS_LINUX)
+
+namespace super_catch {
+    struct module_info {
+        int id;
+        std::string path;
+        uintptr_t base;
+        uint64_t faults;
+        bool loaded;
+    };
+
+    // Rebuilds the index of executable segments from dl_iterate_phdr. Call it after loading or
+    // unloading a shared object by other means than module_dlopen/module_dlclose.
+    void refresh_module_index();
+
+    void *module_dlopen(const char *file, int mode);
+
+    int module_dlclose(void *handle);
+
+    // Lock-free lookup, -1 if the address is not in any executable segment.
+    int module_of(const void *addr) noexcept;
+
+    uint64_t module_fault_count(int id);
+
+    // Every module seen since startup, including unloaded ones. Ids are stable.
+    std::vector<module_info> modules();
+}
+
+namespace super_catch {
+    struct signal_info {
+        int signal;
+        int code;
+        pid_t pid;
+        uid_t uid;
+    };
+
+    // Consumes process-directed signals (SIGTERM, SIGPIPE, ...) through a signalfd instead of
+    // a signal handler, so they never longjmp out of an unrelated SUPER_TRY.
+    // Construct it in the main thread before any other thread is spawned, the signals are
+    // blocked in the calling thread and every thread created afterwards inherits the mask.
+    // The mask is left in place on destruction, so all threads stay consistent.
+    // A SIGPIPE raised by a failed write/send is thread-directed and stays pending on the
+    // writing thread: it is suppressed (EPIPE is still returned) but never dispatched.
+    // Callbacks only fire for process-directed signals, e.g. kill(pid, sig).
+    // Either call start() to dispatch on a dedicated thread, or poll fd() in an external
+    // event loop and call dispatch() when it becomes readable.
+    class signal_dispatcher {
+    public:
+        using callback = std::function<void(const signal_info &)>;
+
+        explicit signal_dispatcher(std::initializer_list<int> signals = {SIGTERM, SIGPIPE});
+
+        ~signal_dispatcher();
+
+        signal_dispatcher(const signal_dispatcher &) = delete;
+
+        signal_dispatcher &operator=(const signal_dispatcher &) = delete;
+
+        // Returns an id which can be passed to remove().
+        int add(int sig, callback cb);
+
+        void remove(int id);
+
+        // Readable file descriptor, for epoll/poll based event loops.
+        int fd() const noexcept { return signal_fd_; }
+
+        // Reads every pending signal without blocking and invokes the callbacks.
+        // Returns the number of signals consumed.
+        int dispatch();
+
+        void start();
+
+        void stop();
+
+    private:
+        void run();
+
+        sigset_t mask_{};
+        int signal_fd_ = -1;
+        int wake_fd_ = -1;
+        int next_id_ = 0;
+        std::mutex mutex_;
+        std::map<int, std::pair<int, callback>> callbacks_;
+        std::thread thread_;
+    };
+}
+
+#endif
+
+#define SUPER_CATCH_POSIX_PUSH_SIGNAL_HANDLER_EX(ln, on_fault) \
     class SUPER_CATCH_CONCATENATE(posix_signal_handler_pop_, ln) { \
     public: \
         ~SUPER_CATCH_CONCATENATE(posix_signal_handler_pop_, ln)() { \
@@ -240,10 +576,19 @@ namespace super_catch {
     std::atomic_signal_fence(std::memory_order_release); \
     if (SUPER_CATCH_CONCATENATE(sig, ln) != 0) { \
         SUPER_CATCH_DEBUG_PRINTF("restore from sigsetjmp %p\n", SUPER_CATCH_CONCATENATE(posix_cur_buf, ln)); \
-        throw std::system_error(static_cast<super_catch::error_code_enum>(SUPER_CATCH_CONCATENATE(sig, ln))); \
+        on_fault; \
+        super_catch::detail::throw_signal_exception(SUPER_CATCH_CONCATENATE(sig, ln)); \
     } \
     SUPER_CATCH_DEBUG_PRINTF("setup sigsetjmp %p\n", SUPER_CATCH_CONCATENATE(posix_cur_buf, ln));
 
+#define SUPER_CATCH_POSIX_PUSH_SIGNAL_HANDLER(ln) \
+    SUPER_CATCH_POSIX_PUSH_SIGNAL_HANDLER_EX(ln, (void)0)
+
+#define SUPER_CATCH_POSIX_PUSH_BREAKER(ln) \
+    static super_catch::circuit_breaker SUPER_CATCH_CONCATENATE(posix_breaker_, ln){__FILE__, __LINE__}; \
+    super_catch::detail::circuit_breaker_scope SUPER_CATCH_CONCATENATE(posix_breaker_scope_, ln){ \
+        SUPER_CATCH_CONCATENATE(posix_breaker_, ln)}; \
+    SUPER_CATCH_POSIX_PUSH_SIGNAL_HANDLER_EX(ln, SUPER_CATCH_CONCATENATE(posix_breaker_scope_, ln).fault())
 
 #define SUPER_TRY \
     try { \
@@ -253,6 +598,13 @@ namespace super_catch {
         while(0); \
     } catch
 
+// Same as SUPER_TRY, but the site fast-fails with circuit_open_exception
+// once its recent fault rate crosses the circuit_breaker_config threshold.
+#define SUPER_TRY_BREAKER \
+    try { \
+        SUPER_CATCH_POSIX_PUSH_BREAKER(__COUNTER__); \
+        do
+
 #else
 
 #error "super-catch not supported on this platform. currently supports Windows (MSVC) and POSIX compatible systems.
@@ -9,8 +9,27 @@
 #include <atomic>
 #include <csetjmp>
 #include <csignal>
-#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
 #include <vector>
+#include <cerrno>
+#include <execinfo.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(SUPER_CATCH_IS_LINUX)
+#include <algorithm>
+#include <dlfcn.h>
+#include <link.h>
+#include <ucontext.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#endif
 
 namespace {
     struct signal_error_category final : std::error_category {
@@ -62,6 +81,296 @@ namespace {
     thread_local super_catch::detail::sigjmp_buf_chain *cur_buf = nullptr;
     std::once_flag init_signal_handler_once_flag{};
     signal_error_category signal_category{};
+
+    std::atomic<uint32_t> breaker_failure_percent{50};
+    std::atomic<uint32_t> breaker_min_calls{20};
+    std::atomic<uint32_t> breaker_window_ms{10000};
+    std::atomic<uint32_t> breaker_cooldown_ms{5000};
+    std::atomic<super_catch::circuit_breaker *> breaker_list{nullptr};
+    std::atomic<unsigned> next_breaker_stripe{0};
+
+    int64_t steady_now_ms() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    unsigned breaker_stripe() {
+        thread_local const unsigned stripe = next_breaker_stripe.fetch_add(1, std::memory_order_relaxed);
+        return stripe;
+    }
+
+    constexpr int guarded_trace_depth = 16;
+
+    enum guarded_slot_state: int {
+        slot_unused,
+        slot_allocated,
+        slot_freed,
+    };
+
+    struct guarded_slot {
+        std::atomic<int> state{slot_unused};
+        uintptr_t ptr = 0;
+        size_t size = 0;
+        void *alloc_trace[guarded_trace_depth]{};
+        int alloc_depth = 0;
+        void *free_trace[guarded_trace_depth]{};
+        int free_depth = 0;
+    };
+
+    // [guard][slot 0][guard][slot 1]...[slot n-1][guard], base and size never change once set
+    std::atomic<uintptr_t> guarded_base{0};
+    std::atomic<size_t> guarded_len{0};
+    size_t guarded_page_size = 0;
+    size_t guarded_slot_count = 0;
+    guarded_slot *guarded_slots = nullptr;
+    std::atomic<uint32_t> guarded_sample_rate{0};
+    std::mutex guarded_mutex;
+    std::deque<size_t> guarded_free_slots;
+    unsigned guarded_alloc_counter = 0;
+    std::once_flag init_guarded_allocator_once_flag{};
+
+    thread_local uint64_t guarded_sample_countdown = 0;
+    thread_local uint32_t guarded_rng = 0;
+
+    struct guarded_report {
+        super_catch::memory_error_type type;
+        const void *fault_address;
+        size_t slot;
+        bool valid;
+    };
+
+    // written by the signal handler (or guarded_free) of the faulting thread, consumed by throw_signal_exception
+    thread_local guarded_report pending_report{};
+
+    uintptr_t guarded_slot_begin(const size_t slot) {
+        return guarded_base.load(std::memory_order_relaxed) + guarded_page_size * (2 * slot + 1);
+    }
+
+    bool guarded_should_sample(const uint32_t rate) {
+        if (guarded_sample_countdown > 1) {
+            guarded_sample_countdown--;
+            return false;
+        }
+
+        if (guarded_rng == 0) {
+            guarded_rng = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&guarded_rng) ^ steady_now_ms()) | 1;
+        }
+        guarded_rng ^= guarded_rng << 13;
+        guarded_rng ^= guarded_rng >> 17;
+        guarded_rng ^= guarded_rng << 5;
+
+        // first call only arms the countdown
+        const bool sample = guarded_sample_countdown == 1;
+        // 64-bit, 2 * rate overflows uint32_t for rates from 2^31
+        guarded_sample_countdown = 1 + guarded_rng % (2 * static_cast<uint64_t>(rate));
+        return sample;
+    }
+
+    // async-signal-safe, only reads slot metadata
+    void classify_guarded_fault(const void *addr) {
+        pending_report.valid = false;
+
+        const auto base = guarded_base.load(std::memory_order_relaxed);
+        const auto a = reinterpret_cast<uintptr_t>(addr);
+        if (base == 0 || a < base || a >= base + guarded_len.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        const size_t page = (a - base) / guarded_page_size;
+        guarded_report report{super_catch::memory_error_type::unknown, addr, 0, false};
+
+        if (page % 2 == 1) {
+            const size_t slot = page / 2;
+            const int state = guarded_slots[slot].state.load(std::memory_order_relaxed);
+            if (state != slot_unused) {
+                report.slot = slot;
+                report.valid = true;
+                if (state == slot_freed) {
+                    report.type = super_catch::memory_error_type::use_after_free;
+                }
+            }
+        } else {
+            // guard page, blame the nearest used slot on either side
+            const size_t right = page / 2;
+            uintptr_t best = UINTPTR_MAX;
+
+            if (right > 0 && guarded_slots[right - 1].state.load(std::memory_order_relaxed) != slot_unused) {
+                const auto &left = guarded_slots[right - 1];
+                best = a - (left.ptr + left.size);
+                report.slot = right - 1;
+                report.type = super_catch::memory_error_type::buffer_overflow;
+                report.valid = true;
+            }
+            if (right < guarded_slot_count &&
+                guarded_slots[right].state.load(std::memory_order_relaxed) != slot_unused &&
+                guarded_slots[right].ptr - a < best) {
+                report.slot = right;
+                report.type = super_catch::memory_error_type::buffer_underflow;
+                report.valid = true;
+            }
+
+            if (report.valid && guarded_slots[report.slot].state.load(std::memory_order_relaxed) == slot_freed) {
+                report.type = super_catch::memory_error_type::use_after_free;
+            }
+        }
+
+        pending_report = report;
+    }
+
+    void write_str(const char *str) {
+        const auto written = write(STDERR_FILENO, str, strlen(str));
+        (void) written;
+    }
+
+    // report for faults outside of SUPER_TRY, runs in the signal handler so it must not allocate
+    void print_guarded_report() {
+        const auto &slot = guarded_slots[pending_report.slot];
+        char buf[160];
+        snprintf(buf, sizeof(buf), "super_catch: %s at %p, %zu-byte allocation at %p\n",
+                 super_catch::memory_error_description(pending_report.type), pending_report.fault_address,
+                 slot.size, reinterpret_cast<void *>(slot.ptr));
+        write_str(buf);
+
+        write_str("allocated by:\n");
+        backtrace_symbols_fd(slot.alloc_trace, slot.alloc_depth, STDERR_FILENO);
+
+        if (slot.state.load(std::memory_order_relaxed) == slot_freed) {
+            write_str("freed by:\n");
+            backtrace_symbols_fd(slot.free_trace, slot.free_depth, STDERR_FILENO);
+        }
+    }
+
+    // faulting instruction of the last signal on this thread, consumed by throw_signal_exception
+    thread_local const void *pending_pc = nullptr;
+    thread_local int pending_module_id = -1;
+
+    const void *fault_pc(void *context) {
+#if defined(SUPER_CATCH_IS_LINUX)
+        const auto uc = static_cast<ucontext_t *>(context);
+#if defined(__x86_64__)
+        return reinterpret_cast<const void *>(uc->uc_mcontext.gregs[REG_RIP]);
+#elif defined(__i386__)
+        return reinterpret_cast<const void *>(uc->uc_mcontext.gregs[REG_EIP]);
+#elif defined(__aarch64__)
+        return reinterpret_cast<const void *>(uc->uc_mcontext.pc);
+#else
+        (void) uc;
+        return nullptr;
+#endif
+#else
+        (void) context;
+        return nullptr;
+#endif
+    }
+
+#if defined(SUPER_CATCH_IS_LINUX)
+    struct module_record {
+        int id;
+        std::string path;
+        uintptr_t base;
+        // libc, faults and aborts inside it are attributed to the calling module
+        bool system;
+        std::atomic<uint64_t> faults{0};
+        std::atomic<bool> loaded{true};
+    };
+
+    struct module_range {
+        uintptr_t begin;
+        uintptr_t end;
+        module_record *module;
+    };
+
+    // immutable once published, sorted by begin
+    struct module_snapshot {
+        std::vector<module_range> ranges;
+    };
+
+    std::mutex module_mutex;
+    // records are never freed, the handler may still hold a pointer to an unloaded module
+    std::vector<module_record *> module_records;
+    std::atomic<const module_snapshot *> module_index{nullptr};
+    // readers register on the counter of the current epoch parity, a refresh flips the epoch
+    // and only waits for readers already in flight, so new readers cannot starve it
+    std::atomic<unsigned> module_index_epoch{0};
+    std::atomic<int> module_index_readers[2];
+
+    bool is_system_module(const std::string &path) {
+        const auto slash = path.rfind('/');
+        const auto name = slash == std::string::npos ? path : path.substr(slash + 1);
+        return name.compare(0, 7, "libc.so") == 0 || name.compare(0, 5, "libc-") == 0 ||
+               name.compare(0, 10, "libpthread") == 0;
+    }
+
+    module_record *find_module(const void *addr) {
+        // seq_cst pairs with the publish-then-flip in refresh_module_index
+        auto &readers = module_index_readers[module_index_epoch.load() & 1];
+        readers.fetch_add(1);
+        const auto snapshot = module_index.load();
+
+        module_record *found = nullptr;
+        if (snapshot != nullptr) {
+            const auto a = reinterpret_cast<uintptr_t>(addr);
+            const auto &ranges = snapshot->ranges;
+            size_t lo = 0;
+            size_t hi = ranges.size();
+            while (lo < hi) {
+                const size_t mid = lo + (hi - lo) / 2;
+                if (ranges[mid].end <= a) {
+                    lo = mid + 1;
+                } else {
+                    hi = mid;
+                }
+            }
+            if (lo < ranges.size() && ranges[lo].begin <= a) {
+                found = ranges[lo].module;
+            }
+        }
+
+        readers.fetch_sub(1);
+        return found;
+    }
+
+    // runs in the signal handler
+    void attribute_fault(const int sig, void *context) {
+        pending_pc = fault_pc(context);
+        pending_module_id = -1;
+
+        auto module = find_module(pending_pc);
+
+        // abort() and bad pointers passed to libc routines fault inside libc, blame the first
+        // caller outside of it. backtrace() was warmed up in init_signal_handler.
+        if (sig == SIGABRT || (module != nullptr && module->system)) {
+            constexpr int max_frames = 32;
+            void *frames[max_frames];
+            const int depth = backtrace(frames, max_frames);
+
+            // skip the handler frames up to the interrupted instruction
+            int i = 0;
+            while (i < depth && frames[i] != pending_pc) {
+                i++;
+            }
+
+            for (i++; i < depth; i++) {
+                // return addresses, step back into the calling instruction
+                const auto caller = find_module(static_cast<const char *>(frames[i]) - 1);
+                if (caller != nullptr && !caller->system) {
+                    module = caller;
+                    break;
+                }
+            }
+        }
+
+        if (module != nullptr) {
+            module->faults.fetch_add(1, std::memory_order_relaxed);
+            pending_module_id = module->id;
+        }
+    }
+#else
+    void attribute_fault(int, void *context) {
+        pending_pc = fault_pc(context);
+        pending_module_id = -1;
+    }
+#endif
 } // anonymous namespace
 
 namespace super_catch {
@@ -80,15 +389,25 @@ namespace super_catch {
 
 namespace super_catch {
     namespace detail {
-        void handler(int const sig, siginfo_t *, void *) {
+        void handler(int const sig, siginfo_t *info, void *context) {
             SUPER_CATCH_DEBUG_PRINTF("enter custom signal handler %d\n", sig);
 
+            attribute_fault(sig, context);
+
+            if ((sig == SIGSEGV || sig == SIGBUS) && info != nullptr) {
+                classify_guarded_fault(info->si_addr);
+            }
+
             if (cur_buf) {
                 SUPER_CATCH_DEBUG_PRINTF("convert signal to std exception %p\n", cur_buf);
                 std::atomic_signal_fence(std::memory_order_acquire);
                 siglongjmp(cur_buf->buf, sig);
             }
 
+            if (pending_report.valid) {
+                print_guarded_report();
+            }
+
             // this signal was not caused within the scope of signal handler object,
             // invoke the default handler
             SUPER_CATCH_DEBUG_PRINTF("invoke default signal handler\n");
@@ -96,23 +415,70 @@ namespace super_catch {
             raise(sig);
         }
 
+        void throw_signal_exception(const int sig) {
+            const int module_id = pending_module_id;
+            const void *pc = pending_pc;
+            pending_module_id = -1;
+            pending_pc = nullptr;
+
+            if (!pending_report.valid) {
+                throw signal_exception(sig, module_id, pc);
+            }
+
+            const auto report = pending_report;
+            pending_report.valid = false;
+
+            std::vector<void *> alloc_trace;
+            std::vector<void *> free_trace;
+            const void *allocation;
+            size_t size;
+            {
+                std::lock_guard<std::mutex> lock(guarded_mutex);
+                const auto &slot = guarded_slots[report.slot];
+                allocation = reinterpret_cast<const void *>(slot.ptr);
+                size = slot.size;
+                alloc_trace.assign(slot.alloc_trace, slot.alloc_trace + slot.alloc_depth);
+                if (slot.state.load(std::memory_order_relaxed) == slot_freed) {
+                    free_trace.assign(slot.free_trace, slot.free_trace + slot.free_depth);
+                }
+            }
+
+            throw memory_error(sig, module_id, pc, report.type, report.fault_address, allocation, size,
+                               std::move(alloc_trace), std::move(free_trace));
+        }
+
+        void setup_handler();
+
+        void init_signal_handler() {
+            std::call_once(init_signal_handler_once_flag, []() {
+#if defined(SUPER_CATCH_IS_LINUX)
+                refresh_module_index();
+
+                // the first backtrace() may allocate while loading the unwinder, the handler uses it
+                void *warmup[1];
+                backtrace(warmup, 1);
+#endif
+                SUPER_CATCH_DEBUG_PRINTF("register global custom signal handler\n");
+                setup_handler();
+            });
+        }
+
         void setup_handler() {
             struct sigaction sa{};
             sa.sa_sigaction = &handler;
             sigemptyset(&sa.sa_mask);
             sa.sa_flags = SA_SIGINFO;
 
-            static std::vector<int> signals_to_catch{SIGILL, SIGABRT, SIGFPE, SIGTRAP, SIGSEGV, SIGBUS, SIGPIPE, SIGTERM};
+            // only synchronous signals, they are delivered to the faulting thread which owns the guard.
+            // process-directed signals (SIGTERM, SIGPIPE) go to an arbitrary thread, see signal_dispatcher.
+            static std::vector<int> signals_to_catch{SIGILL, SIGABRT, SIGFPE, SIGTRAP, SIGSEGV, SIGBUS};
             for (const auto to_catch: signals_to_catch) {
                 sigaction(to_catch, &sa, nullptr);
             }
         }
 
         sigjmp_buf_chain *sigjmp_chain_push() {
-            std::call_once(init_signal_handler_once_flag, []() {
-                SUPER_CATCH_DEBUG_PRINTF("register global custom signal handler\n");
-                setup_handler();
-            });
+            init_signal_handler();
 
             const auto prev_buf = cur_buf;
             cur_buf = new sigjmp_buf_chain();
@@ -143,6 +509,594 @@ namespace super_catch {
     }
 }
 
+namespace super_catch {
+    void set_circuit_breaker_config(const circuit_breaker_config &config) {
+        if (config.failure_percent != 0) breaker_failure_percent.store(config.failure_percent);
+        if (config.min_calls != 0) breaker_min_calls.store(config.min_calls);
+        if (config.window_ms != 0) breaker_window_ms.store(config.window_ms);
+        if (config.cooldown_ms != 0) breaker_cooldown_ms.store(config.cooldown_ms);
+    }
+
+    circuit_breaker_config get_circuit_breaker_config() {
+        circuit_breaker_config config;
+        config.failure_percent = breaker_failure_percent.load();
+        config.min_calls = breaker_min_calls.load();
+        config.window_ms = breaker_window_ms.load();
+        config.cooldown_ms = breaker_cooldown_ms.load();
+        return config;
+    }
+
+    circuit_breaker *circuit_breakers() noexcept {
+        return breaker_list.load(std::memory_order_acquire);
+    }
+
+    circuit_breaker::circuit_breaker(const char *file, const int line) noexcept: file_(file), line_(line) {
+        next_ = breaker_list.load(std::memory_order_relaxed);
+        while (!breaker_list.compare_exchange_weak(next_, this, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+
+    void circuit_breaker::configure(const circuit_breaker_config &config) noexcept {
+        failure_percent_.store(config.failure_percent);
+        min_calls_.store(config.min_calls);
+        window_ms_.store(config.window_ms);
+        cooldown_ms_.store(config.cooldown_ms);
+    }
+
+    circuit_breaker_config circuit_breaker::effective_config() const noexcept {
+        circuit_breaker_config config;
+        config.failure_percent = failure_percent_.load(std::memory_order_relaxed);
+        config.min_calls = min_calls_.load(std::memory_order_relaxed);
+        config.window_ms = window_ms_.load(std::memory_order_relaxed);
+        config.cooldown_ms = cooldown_ms_.load(std::memory_order_relaxed);
+
+        if (config.failure_percent == 0) config.failure_percent = breaker_failure_percent.load(std::memory_order_relaxed);
+        if (config.min_calls == 0) config.min_calls = breaker_min_calls.load(std::memory_order_relaxed);
+        if (config.window_ms == 0) config.window_ms = breaker_window_ms.load(std::memory_order_relaxed);
+        if (config.cooldown_ms == 0) config.cooldown_ms = breaker_cooldown_ms.load(std::memory_order_relaxed);
+        return config;
+    }
+
+    circuit_breaker::admission_enum circuit_breaker::allow() noexcept {
+        int state = state_.load(std::memory_order_acquire);
+        if (state == closed) {
+            return admitted;
+        }
+
+        if (state == open) {
+            const auto config = effective_config();
+            if (steady_now_ms() - opened_at_ms_.load(std::memory_order_relaxed) < config.cooldown_ms) {
+                return rejected;
+            }
+
+            // the thread winning the transition runs the single probe call
+            if (state_.compare_exchange_strong(state, half_open, std::memory_order_acq_rel)) {
+                SUPER_CATCH_DEBUG_PRINTF("circuit breaker %s:%d half open\n", file_, line_);
+                return probe;
+            }
+        }
+
+        return rejected;
+    }
+
+    void circuit_breaker::record_success(const admission_enum admission) noexcept {
+        if (admission == probe) {
+            // clear the window before closing, calls admitted once closed must not be wiped
+            reset();
+            state_.store(closed, std::memory_order_release);
+            SUPER_CATCH_DEBUG_PRINTF("circuit breaker %s:%d closed\n", file_, line_);
+            return;
+        }
+
+        // calls admitted before the breaker tripped are dropped unless it is closed
+        if (state_.load(std::memory_order_acquire) == closed) {
+            record(false, steady_now_ms(), effective_config());
+        }
+    }
+
+    void circuit_breaker::record_fault(const admission_enum admission) noexcept {
+        const auto now = steady_now_ms();
+
+        if (admission == probe) {
+            opened_at_ms_.store(now, std::memory_order_relaxed);
+            state_.store(open, std::memory_order_release);
+            SUPER_CATCH_DEBUG_PRINTF("circuit breaker %s:%d probe failed, open\n", file_, line_);
+            return;
+        }
+
+        if (state_.load(std::memory_order_acquire) == closed) {
+            const auto config = effective_config();
+            record(true, now, config);
+            if (should_trip(now, config)) {
+                trip(now);
+            }
+        }
+    }
+
+    void circuit_breaker::reset() noexcept {
+        for (auto &s: stripes_) {
+            for (auto &b: s.buckets) {
+                b.epoch.store(-1, std::memory_order_relaxed);
+                b.calls.store(0, std::memory_order_relaxed);
+                b.faults.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void circuit_breaker::record(const bool fault, const int64_t now_ms, const circuit_breaker_config &config) noexcept {
+        const int64_t bucket_ms = config.window_ms / bucket_count > 0 ? config.window_ms / bucket_count : 1;
+        const int64_t epoch = now_ms / bucket_ms;
+        auto &b = stripes_[breaker_stripe() % stripe_count].buckets[epoch % bucket_count];
+
+        // stale bucket from a previous lap of the window, the thread winning the swap clears it
+        int64_t seen = b.epoch.load(std::memory_order_relaxed);
+        if (seen != epoch && b.epoch.compare_exchange_strong(seen, epoch, std::memory_order_relaxed)) {
+            b.calls.store(0, std::memory_order_relaxed);
+            b.faults.store(0, std::memory_order_relaxed);
+        }
+
+        b.calls.fetch_add(1, std::memory_order_relaxed);
+        if (fault) {
+            b.faults.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    bool circuit_breaker::should_trip(const int64_t now_ms, const circuit_breaker_config &config) const noexcept {
+        const int64_t bucket_ms = config.window_ms / bucket_count > 0 ? config.window_ms / bucket_count : 1;
+        const int64_t oldest = now_ms / bucket_ms - (bucket_count - 1);
+
+        uint64_t calls = 0;
+        uint64_t faults = 0;
+        for (const auto &s: stripes_) {
+            for (const auto &b: s.buckets) {
+                if (b.epoch.load(std::memory_order_relaxed) >= oldest) {
+                    calls += b.calls.load(std::memory_order_relaxed);
+                    faults += b.faults.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        return calls >= config.min_calls && faults * 100 >= static_cast<uint64_t>(config.failure_percent) * calls;
+    }
+
+    void circuit_breaker::trip(const int64_t now_ms) noexcept {
+        // the timestamp must be visible before open is, allow() reads it right after seeing open.
+        // losing the race only refreshes the timestamp of a breaker that just opened
+        opened_at_ms_.store(now_ms, std::memory_order_relaxed);
+
+        int state = closed;
+        if (state_.compare_exchange_strong(state, open, std::memory_order_acq_rel)) {
+            SUPER_CATCH_DEBUG_PRINTF("circuit breaker %s:%d open\n", file_, line_);
+        }
+    }
+}
+
+namespace super_catch {
+    void init_guarded_allocator(const guarded_allocator_options &options) {
+        std::call_once(init_guarded_allocator_once_flag, [&options]() {
+            const auto page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+            if (options.slot_count == 0) {
+                throw std::system_error(std::make_error_code(std::errc::invalid_argument), "slot_count");
+            }
+            if (options.slot_count > (SIZE_MAX / page_size - 1) / 2) {
+                throw std::system_error(std::make_error_code(std::errc::value_too_large), "slot_count");
+            }
+
+            guarded_page_size = page_size;
+            guarded_slot_count = options.slot_count;
+
+            const size_t len = guarded_page_size * (2 * guarded_slot_count + 1);
+            void *base = mmap(nullptr, len, PROT_NONE, MAP_PRIVATE | MAP_ANON, -1, 0);
+            if (base == MAP_FAILED) {
+                throw std::system_error(errno, std::generic_category(), "mmap");
+            }
+
+            guarded_slots = new guarded_slot[guarded_slot_count];
+            for (size_t i = 0; i < guarded_slot_count; i++) {
+                guarded_free_slots.push_back(i);
+            }
+
+            // the first backtrace() may allocate while loading the unwinder, do it here
+            void *warmup[1];
+            backtrace(warmup, 1);
+
+            guarded_len.store(len);
+            guarded_base.store(reinterpret_cast<uintptr_t>(base));
+            detail::init_signal_handler();
+
+            SUPER_CATCH_DEBUG_PRINTF("guarded allocator %zu slots at %p\n", guarded_slot_count, base);
+        });
+
+        guarded_sample_rate.store(options.sample_rate);
+    }
+
+    bool guarded_owns(const void *ptr) noexcept {
+        const auto base = guarded_base.load(std::memory_order_relaxed);
+        const auto p = reinterpret_cast<uintptr_t>(ptr);
+        return base != 0 && p >= base && p < base + guarded_len.load(std::memory_order_relaxed);
+    }
+
+    void *sampling_malloc(const size_t size) {
+        const auto rate = guarded_sample_rate.load(std::memory_order_relaxed);
+        if (rate != 0 && guarded_should_sample(rate)) {
+            if (const auto ptr = guarded_malloc(size)) {
+                return ptr;
+            }
+        }
+        return malloc(size);
+    }
+
+    void sampling_free(void *ptr) {
+        if (guarded_owns(ptr)) {
+            guarded_free(ptr);
+        } else {
+            free(ptr);
+        }
+    }
+
+    void *guarded_malloc(const size_t size) {
+        if (guarded_base.load(std::memory_order_acquire) == 0 || size == 0 || size > guarded_page_size) {
+            return nullptr;
+        }
+
+        std::lock_guard<std::mutex> lock(guarded_mutex);
+        if (guarded_free_slots.empty()) {
+            return nullptr;
+        }
+
+        // oldest freed slot first, keeps recently freed memory protected for longer
+        const size_t index = guarded_free_slots.front();
+        guarded_free_slots.pop_front();
+
+        const auto begin = guarded_slot_begin(index);
+        if (mprotect(reinterpret_cast<void *>(begin), guarded_page_size, PROT_READ | PROT_WRITE) != 0) {
+            guarded_free_slots.push_front(index);
+            return nullptr;
+        }
+
+        // alternate between the right edge (catches overflow) and the left edge (catches underflow)
+        constexpr size_t alignment = alignof(std::max_align_t);
+        const size_t rounded = (size + alignment - 1) / alignment * alignment;
+        const bool right_aligned = (guarded_alloc_counter++ & 1) == 0;
+
+        auto &slot = guarded_slots[index];
+        slot.ptr = right_aligned ? begin + guarded_page_size - rounded : begin;
+        slot.size = size;
+        slot.alloc_depth = backtrace(slot.alloc_trace, guarded_trace_depth);
+        slot.free_depth = 0;
+        slot.state.store(slot_allocated, std::memory_order_release);
+
+        return reinterpret_cast<void *>(slot.ptr);
+    }
+
+    void guarded_free(void *ptr) {
+        if (!guarded_owns(ptr)) {
+            return;
+        }
+
+        const auto p = reinterpret_cast<uintptr_t>(ptr);
+        size_t index = (p - guarded_base.load(std::memory_order_relaxed)) / guarded_page_size / 2;
+        if (index >= guarded_slot_count) {
+            index = guarded_slot_count - 1;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(guarded_mutex);
+            auto &slot = guarded_slots[index];
+            if (slot.state.load(std::memory_order_relaxed) == slot_allocated && slot.ptr == p) {
+                slot.free_depth = backtrace(slot.free_trace, guarded_trace_depth);
+                slot.state.store(slot_freed, std::memory_order_release);
+                mprotect(reinterpret_cast<void *>(guarded_slot_begin(index)), guarded_page_size, PROT_NONE);
+                guarded_free_slots.push_back(index);
+                return;
+            }
+        }
+
+        // double or invalid free, surfaces as SIGABRT carrying the report
+        pending_report = guarded_report{memory_error_type::double_free, ptr, index, true};
+        abort();
+    }
+
+    const char *memory_error_description(const memory_error_type type) noexcept {
+        switch (type) {
+            case memory_error_type::buffer_overflow: return "buffer overflow";
+            case memory_error_type::buffer_underflow: return "buffer underflow";
+            case memory_error_type::use_after_free: return "use after free";
+            case memory_error_type::double_free: return "double free";
+            default: return "unknown memory error";
+        }
+    }
+
+    signal_exception::signal_exception(const int sig, const int module_id, const void *pc)
+        : std::system_error(static_cast<error_code_enum>(sig)), module_id_(module_id), pc_(pc) {
+    }
+
+    memory_error::memory_error(const int sig, const int module_id, const void *pc, const memory_error_type type,
+                               const void *fault_address, const void *allocation, const size_t allocation_size,
+                               std::vector<void *> allocation_trace, std::vector<void *> deallocation_trace)
+        : signal_exception(sig, module_id, pc), type_(type), fault_address_(fault_address),
+          allocation_(allocation), allocation_size_(allocation_size),
+          allocation_trace_(std::move(allocation_trace)), deallocation_trace_(std::move(deallocation_trace)) {
+        constexpr int buf_len = 160;
+        char buf[buf_len];
+        const int len = snprintf(buf, buf_len, "%s at %p, %zu-byte allocation at %p",
+                                 memory_error_description(type), fault_address, allocation_size, allocation);
+        msg_ = std::string(buf, len);
+    }
+}
+
+#if defined(SUPER_CATCH_IS_LINUX)
+
+namespace super_catch {
+    void refresh_module_index() {
+        std::lock_guard<std::mutex> lock(module_mutex);
+
+        auto snapshot = new module_snapshot();
+        std::vector<module_record *> seen;
+
+        struct context {
+            module_snapshot *snapshot;
+            std::vector<module_record *> *seen;
+            bool first;
+        } ctx{snapshot, &seen, true};
+
+        dl_iterate_phdr([](dl_phdr_info *info, size_t, void *data) -> int {
+            const auto ctx = static_cast<context *>(data);
+
+            std::string path = info->dlpi_name != nullptr ? info->dlpi_name : "";
+            if (path.empty() && ctx->first) {
+                // the main executable comes first and has no name
+                char exe[4096];
+                const auto len = readlink("/proc/self/exe", exe, sizeof(exe));
+                if (len > 0) {
+                    path.assign(exe, static_cast<size_t>(len));
+                }
+            }
+            ctx->first = false;
+
+            module_record *module = nullptr;
+            for (const auto record: module_records) {
+                if (record->base == info->dlpi_addr && record->path == path) {
+                    module = record;
+                    break;
+                }
+            }
+
+            bool executable = false;
+            for (int i = 0; i < info->dlpi_phnum; i++) {
+                const auto &phdr = info->dlpi_phdr[i];
+                if (phdr.p_type != PT_LOAD || (phdr.p_flags & PF_X) == 0) {
+                    continue;
+                }
+
+                if (module == nullptr) {
+                    module = new module_record();
+                    module->id = static_cast<int>(module_records.size());
+                    module->path = path;
+                    module->base = info->dlpi_addr;
+                    module->system = is_system_module(path);
+                    module_records.push_back(module);
+                }
+
+                const uintptr_t begin = info->dlpi_addr + phdr.p_vaddr;
+                ctx->snapshot->ranges.push_back({begin, begin + phdr.p_memsz, module});
+                executable = true;
+            }
+
+            if (executable) {
+                ctx->seen->push_back(module);
+            }
+            return 0;
+        }, &ctx);
+
+        std::sort(snapshot->ranges.begin(), snapshot->ranges.end(),
+                  [](const module_range &a, const module_range &b) { return a.begin < b.begin; });
+
+        for (const auto record: module_records) {
+            record->loaded.store(std::find(seen.begin(), seen.end(), record) != seen.end());
+        }
+
+        // publish, then two grace periods: each flips the epoch and waits only for the readers
+        // registered on the previous parity, which covers any reader that saw the old snapshot
+        const auto old = module_index.exchange(snapshot);
+        for (int i = 0; i < 2; i++) {
+            const unsigned epoch = module_index_epoch.fetch_add(1);
+            while (module_index_readers[epoch & 1].load() != 0) {
+                std::this_thread::yield();
+            }
+        }
+        delete old;
+
+        SUPER_CATCH_DEBUG_PRINTF("module index refreshed, %zu executable segments\n", snapshot->ranges.size());
+    }
+
+    void *module_dlopen(const char *file, const int mode) {
+        const auto handle = dlopen(file, mode);
+        if (handle != nullptr) {
+            refresh_module_index();
+        }
+        return handle;
+    }
+
+    int module_dlclose(void *handle) {
+        const int ret = dlclose(handle);
+        refresh_module_index();
+        return ret;
+    }
+
+    int module_of(const void *addr) noexcept {
+        const auto module = find_module(addr);
+        return module != nullptr ? module->id : -1;
+    }
+
+    uint64_t module_fault_count(const int id) {
+        std::lock_guard<std::mutex> lock(module_mutex);
+        if (id < 0 || static_cast<size_t>(id) >= module_records.size()) {
+            return 0;
+        }
+        return module_records[id]->faults.load(std::memory_order_relaxed);
+    }
+
+    std::vector<module_info> modules() {
+        std::lock_guard<std::mutex> lock(module_mutex);
+
+        std::vector<module_info> result;
+        result.reserve(module_records.size());
+        for (const auto record: module_records) {
+            result.push_back({
+                record->id, record->path, record->base, record->faults.load(std::memory_order_relaxed),
+                record->loaded.load(std::memory_order_relaxed)
+            });
+        }
+        return result;
+    }
+
+    signal_dispatcher::signal_dispatcher(const std::initializer_list<int> signals) {
+        sigemptyset(&mask_);
+        for (const auto sig: signals) {
+            sigaddset(&mask_, sig);
+        }
+
+        sigset_t old_mask;
+        const int err = pthread_sigmask(SIG_BLOCK, &mask_, &old_mask);
+        if (err != 0) {
+            throw std::system_error(err, std::generic_category(), "pthread_sigmask");
+        }
+
+        signal_fd_ = signalfd(-1, &mask_, SFD_NONBLOCK | SFD_CLOEXEC);
+        if (signal_fd_ < 0) {
+            // nothing would read the signals, don't leave them blocked
+            const int e = errno;
+            pthread_sigmask(SIG_SETMASK, &old_mask, nullptr);
+            throw std::system_error(e, std::generic_category(), "signalfd");
+        }
+
+        SUPER_CATCH_DEBUG_PRINTF("signal dispatcher created fd %d\n", signal_fd_);
+    }
+
+    signal_dispatcher::~signal_dispatcher() {
+        stop();
+        close(signal_fd_);
+    }
+
+    int signal_dispatcher::add(const int sig, callback cb) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const int id = next_id_++;
+        callbacks_.emplace(id, std::make_pair(sig, std::move(cb)));
+        return id;
+    }
+
+    void signal_dispatcher::remove(const int id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        callbacks_.erase(id);
+    }
+
+    int signal_dispatcher::dispatch() {
+        int consumed = 0;
+        signalfd_siginfo ssi{};
+
+        while (read(signal_fd_, &ssi, sizeof(ssi)) == sizeof(ssi)) {
+            consumed++;
+
+            const signal_info info{
+                static_cast<int>(ssi.ssi_signo), ssi.ssi_code, static_cast<pid_t>(ssi.ssi_pid),
+                static_cast<uid_t>(ssi.ssi_uid)
+            };
+            SUPER_CATCH_DEBUG_PRINTF("signal dispatcher received %d\n", info.signal);
+
+            // copy out so callbacks may add or remove without deadlocking
+            std::vector<callback> to_invoke;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (const auto &entry: callbacks_) {
+                    if (entry.second.first == info.signal) {
+                        to_invoke.push_back(entry.second.second);
+                    }
+                }
+            }
+
+            for (const auto &cb: to_invoke) {
+                cb(info);
+            }
+        }
+
+        return consumed;
+    }
+
+    void signal_dispatcher::start() {
+        if (thread_.joinable()) {
+            return;
+        }
+
+        wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (wake_fd_ < 0) {
+            throw std::system_error(errno, std::generic_category(), "eventfd");
+        }
+
+        thread_ = std::thread(&signal_dispatcher::run, this);
+    }
+
+    void signal_dispatcher::stop() {
+        if (!thread_.joinable()) {
+            return;
+        }
+
+        constexpr uint64_t one = 1;
+        const auto written = write(wake_fd_, &one, sizeof(one));
+        (void) written;
+
+        thread_.join();
+        close(wake_fd_);
+        wake_fd_ = -1;
+    }
+
+    void signal_dispatcher::run() {
+        const int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_fd < 0) {
+            SUPER_CATCH_DEBUG_PRINTF("signal dispatcher epoll_create1 failed %d\n", errno);
+            return;
+        }
+
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = signal_fd_;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, signal_fd_, &ev);
+        ev.data.fd = wake_fd_;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd_, &ev);
+
+        bool running = true;
+        while (running) {
+            epoll_event events[2];
+            const int n = epoll_wait(epoll_fd, events, 2, -1);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+
+            for (int i = 0; i < n; i++) {
+                if (events[i].data.fd == wake_fd_) {
+                    running = false;
+                } else {
+                    // a throwing callback must not terminate the process from this thread
+                    try {
+                        dispatch();
+                    } catch (const std::exception &e) {
+                        SUPER_CATCH_DEBUG_PRINTF("signal dispatcher callback threw %s\n", e.what());
+                    } catch (...) {
+                        SUPER_CATCH_DEBUG_PRINTF("signal dispatcher callback threw\n");
+                    }
+                }
+            }
+        }
+
+        close(epoll_fd);
+    }
+}
+
+#endif
+
 #endif
 
 #if defined(SUPER_CATCH_PLAT_WIN_MSVC)
@@ -1,8 +1,13 @@
 // Written by Reito in 2024
 
 #include "super_catch/super_catch.h"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
 #include <functional>
 #include <memory>
+#include <thread>
 
 #if defined(SUPER_CATCH_PLAT_WIN_MSVC)
 #include <windows.h>
@@ -120,6 +125,217 @@ void TestSegFault() {
     SUPER_CATCH_TEST_END();
 }
 
+#if defined(SUPER_CATCH_PLAT_POSIX_COMPATIBLE)
+const char *BreakerGuardedCall(const bool fault) {
+    SUPER_TRY_BREAKER {
+        if (fault) {
+            std::unique_ptr<TestClass> test;
+            test->TestMethod();
+        }
+    } SUPER_CATCH (const super_catch::circuit_open_exception &e) {
+        return "fast-failed";
+    } catch (const std::exception &e) {
+        return "faulted";
+    }
+    return "ok";
+}
+
+void TestCircuitBreaker() {
+    SUPER_CATCH_TEST_START();
+
+    super_catch::circuit_breaker_config config;
+    config.failure_percent = 50;
+    config.min_calls = 4;
+    config.cooldown_ms = 50;
+    super_catch::set_circuit_breaker_config(config);
+
+    for (int i = 0; i < 6; i++) {
+        SUPER_CATCH_TEST_PRINTF(">> call %d %s\n", i, BreakerGuardedCall(true));
+    }
+
+    // After the cooldown a successful probe closes the breaker again
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    SUPER_CATCH_TEST_PRINTF(">> probe %s\n", BreakerGuardedCall(false));
+
+    // A call admitted before the trip finishing while half open must not decide the probe's outcome
+    static super_catch::circuit_breaker breaker{__FILE__, __LINE__};
+    breaker.configure(config);
+    const auto stale = breaker.allow();
+    for (int i = 0; i < 4; i++) {
+        breaker.record_fault(breaker.allow());
+    }
+    SUPER_CATCH_TEST_PRINTF(">> right after trip %s\n",
+                            breaker.allow() == super_catch::circuit_breaker::rejected ? "rejected" : "admitted");
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    const auto probe = breaker.allow();
+    breaker.record_fault(stale);
+    SUPER_CATCH_TEST_PRINTF(">> stale fault while half open, state %d\n", breaker.state());
+    breaker.record_success(probe);
+    SUPER_CATCH_TEST_PRINTF(">> probe %s, state %d\n",
+                            probe == super_catch::circuit_breaker::probe ? "admitted" : "not admitted",
+                            breaker.state());
+
+    for (auto b = super_catch::circuit_breakers(); b != nullptr; b = b->next()) {
+        SUPER_CATCH_TEST_PRINTF(">> breaker %s:%d state %d\n", b->file(), b->line(), b->state());
+    }
+
+    SUPER_CATCH_TEST_END();
+}
+#endif
+
+#if defined(SUPER_CATCH_PLAT_POSIX_COMPATIBLE)
+void TestGuardedAllocator() {
+    SUPER_CATCH_TEST_START();
+
+    super_catch::guarded_allocator_options options;
+    options.slot_count = 16;
+    options.sample_rate = 100;
+    super_catch::init_guarded_allocator(options);
+
+    int sampled = 0;
+    for (int i = 0; i < 1000; i++) {
+        const auto ptr = static_cast<char *>(super_catch::sampling_malloc(64));
+        ptr[0] = 1;
+        sampled += super_catch::guarded_owns(ptr) ? 1 : 0;
+        super_catch::sampling_free(ptr);
+    }
+    SUPER_CATCH_TEST_PRINTF(">> %d of 1000 allocations sampled\n", sampled);
+
+    for (int i = 0; i < 2; i++) {
+        const auto ptr = static_cast<char *>(super_catch::guarded_malloc(32));
+        // The allocation sits on the left or right edge of its slot
+        SUPER_TRY {
+            ptr[-1] = 1;
+        } SUPER_CATCH (const super_catch::memory_error &e) {
+            SUPER_CATCH_TEST_PRINTF(">> super catched memory error: %s\n", e.what());
+        }
+        SUPER_TRY {
+            ptr[4096] = 1;
+        } SUPER_CATCH (const super_catch::memory_error &e) {
+            SUPER_CATCH_TEST_PRINTF(">> super catched memory error: %s\n", e.what());
+        }
+        super_catch::guarded_free(ptr);
+    }
+
+    // Underflow into a freed slot blames that slot, not the live neighbour on the other side
+    const auto live = static_cast<char *>(super_catch::guarded_malloc(32));
+    const auto freed = static_cast<char *>(super_catch::guarded_malloc(32));
+    super_catch::guarded_free(freed);
+    SUPER_TRY {
+        freed[-100] = 1;
+        freed[-4096] = 1;
+    } SUPER_CATCH (const super_catch::memory_error &e) {
+        SUPER_CATCH_TEST_PRINTF(">> super catched memory error: %s\n", e.what());
+    }
+    super_catch::guarded_free(live);
+
+    const auto ptr = static_cast<char *>(super_catch::guarded_malloc(32));
+    super_catch::guarded_free(ptr);
+    SUPER_TRY {
+        ptr[0] = 1;
+    } SUPER_CATCH (const super_catch::memory_error &e) {
+        SUPER_CATCH_TEST_PRINTF(">> super catched memory error: %s (%zu frames)\n", e.what(),
+                                e.deallocation_trace().size());
+    }
+
+    SUPER_TRY {
+        super_catch::guarded_free(ptr);
+    } SUPER_CATCH (const std::system_error &e) {
+        SUPER_CATCH_TEST_PRINTF(">> super catched exception: %s\n", e.what());
+    }
+
+    SUPER_CATCH_TEST_END();
+}
+#endif
+
+#if defined(SUPER_CATCH_IS_LINUX)
+void TestModuleAttribution() {
+    SUPER_CATCH_TEST_START();
+
+    super_catch::refresh_module_index();
+
+    SUPER_TRY {
+        std::unique_ptr<TestClass> test;
+        test->TestMethod();
+    } SUPER_CATCH (const super_catch::signal_exception &e) {
+        SUPER_CATCH_TEST_PRINTF(">> super catched exception: %s in module %d at %p\n", e.what(), e.module_id(),
+                                e.pc());
+        SUPER_CATCH_TEST_PRINTF(">> own module %d\n",
+                                super_catch::module_of(reinterpret_cast<void *>(&TestModuleAttribution)));
+    }
+
+    // Both fault inside libc, attributed to this module instead
+    SUPER_TRY {
+        abort();
+    } SUPER_CATCH (const super_catch::signal_exception &e) {
+        SUPER_CATCH_TEST_PRINTF(">> super catched exception: %s in module %d\n", e.what(), e.module_id());
+    }
+
+    SUPER_TRY {
+        const char *volatile bad = nullptr;
+        SUPER_CATCH_TEST_PRINTF(">> unexpected length %zu\n", strlen(bad));
+    } SUPER_CATCH (const super_catch::signal_exception &e) {
+        SUPER_CATCH_TEST_PRINTF(">> super catched exception: %s in module %d\n", e.what(), e.module_id());
+    }
+
+    for (const auto &module: super_catch::modules()) {
+        if (module.faults > 0) {
+            SUPER_CATCH_TEST_PRINTF(">> module %d %s faults %llu\n", module.id, module.path.c_str(),
+                                    static_cast<unsigned long long>(module.faults));
+        }
+    }
+
+    SUPER_CATCH_TEST_END();
+}
+
+void TestSignalDispatcher() {
+    SUPER_CATCH_TEST_START();
+
+    std::atomic<int> received{0};
+
+    super_catch::signal_dispatcher dispatcher({SIGTERM, SIGPIPE});
+    dispatcher.add(SIGTERM, [&received](const super_catch::signal_info &info) {
+        SUPER_CATCH_TEST_PRINTF(">> dispatched signal %d from pid %d\n", info.signal, info.pid);
+        received++;
+    });
+    dispatcher.add(SIGPIPE, [](const super_catch::signal_info &) {
+        SUPER_CATCH_TEST_PRINTF(">> unexpected SIGPIPE dispatched\n");
+    });
+    dispatcher.start();
+
+    SUPER_TRY {
+        // Process-directed, must not be turned into an exception here
+        kill(getpid(), SIGTERM);
+    } SUPER_CATCH (const std::exception &e) {
+        SUPER_CATCH_TEST_PRINTF(">> unexpected exception: %s\n", e.what());
+    }
+
+    for (int i = 0; i < 100 && received == 0; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    // Thread-directed SIGPIPE from a real EPIPE write on another thread, suppressed but not dispatched
+    int fds[2];
+    if (pipe(fds) == 0) {
+        close(fds[0]);
+        std::thread writer([&fds]() {
+            const char c = 0;
+            const auto ret = write(fds[1], &c, 1);
+            SUPER_CATCH_TEST_PRINTF(">> write to closed pipe returned %d (%s)\n", static_cast<int>(ret),
+                                    ret < 0 && errno == EPIPE ? "EPIPE" : "unexpected");
+        });
+        writer.join();
+        close(fds[1]);
+    }
+
+    dispatcher.stop();
+
+    SUPER_CATCH_TEST_PRINTF(">> dispatched %d signal(s)\n", received.load());
+
+    SUPER_CATCH_TEST_END();
+}
+#endif
+
 int main() {
     setvbuf(stdout, nullptr, _IONBF, 0);
     setvbuf(stderr, nullptr, _IONBF, 0);
@@ -128,6 +344,16 @@ int main() {
     TestSegFault();
     TestAbort();
 
+#if defined(SUPER_CATCH_PLAT_POSIX_COMPATIBLE)
+    TestCircuitBreaker();
+    TestGuardedAllocator();
+#endif
+
+#if defined(SUPER_CATCH_IS_LINUX)
+    TestModuleAttribution();
+    TestSignalDispatcher();
+#endif
+
 #if defined(SUPER_CATCH_PLAT_WIN_MSVC)
     TestExecuteStack();
 #endif